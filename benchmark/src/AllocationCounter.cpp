@@ -0,0 +1,251 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+
+std::atomic<std::uint64_t> gAllocations{0};
+std::atomic<std::uint64_t> gAllocatedBytes{0};
+std::atomic<std::uint64_t> gDeallocations{0};
+std::atomic<std::int64_t> gLiveBytes{0};
+
+
+inline void countAllocation(std::size_t size) noexcept {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+
+inline void countDeallocation(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        gDeallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+}
+
+
+auto AllocationCounter::allocations() noexcept -> std::uint64_t {
+    return gAllocations.load(std::memory_order_relaxed);
+}
+
+
+auto AllocationCounter::allocatedBytes() noexcept -> std::uint64_t {
+    return gAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+
+auto AllocationCounter::deallocations() noexcept -> std::uint64_t {
+    return gDeallocations.load(std::memory_order_relaxed);
+}
+
+
+auto AllocationCounter::liveBytes() noexcept -> std::int64_t {
+    return gLiveBytes.load(std::memory_order_relaxed);
+}
+
+
+#if defined(__GLIBC__)
+
+
+#include <malloc.h>
+
+
+namespace {
+
+
+inline void addLiveBytes(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        gLiveBytes.fetch_add(static_cast<std::int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    }
+}
+
+
+inline void removeLiveBytes(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        gLiveBytes.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    }
+}
+
+
+}
+
+
+// Replace the allocation functions of the C library. The C++ runtime and Qt both end up here.
+// The aligned variants are replaced as well, because the aligned `operator new` of the C++ runtime uses
+// them and the blocks are released using `free()`. Every block that is released was counted as allocation.
+extern "C" {
+void *__libc_malloc(std::size_t size) noexcept;
+void *__libc_calloc(std::size_t count, std::size_t size) noexcept;
+void *__libc_realloc(void *ptr, std::size_t size) noexcept;
+void *__libc_memalign(std::size_t alignment, std::size_t size) noexcept;
+void *__libc_valloc(std::size_t size) noexcept;
+void *__libc_pvalloc(std::size_t size) noexcept;
+void __libc_free(void *ptr) noexcept;
+
+
+void *malloc(std::size_t size) noexcept {
+    countAllocation(size);
+    auto result = __libc_malloc(size);
+    addLiveBytes(result);
+    return result;
+}
+
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+    countAllocation(count * size);
+    auto result = __libc_calloc(count, size);
+    addLiveBytes(result);
+    return result;
+}
+
+
+void *realloc(void *ptr, std::size_t size) noexcept {
+    removeLiveBytes(ptr);
+    auto result = __libc_realloc(ptr, size);
+    if (result != nullptr) {
+        // The original block is released and replaced by the new one.
+        countAllocation(size);
+        countDeallocation(ptr);
+        addLiveBytes(result);
+    } else if (size == 0) {
+        countDeallocation(ptr); // a size of zero releases the block.
+    } else {
+        addLiveBytes(ptr); // the original block is kept if the reallocation failed.
+    }
+    return result;
+}
+
+
+void *memalign(std::size_t alignment, std::size_t size) noexcept {
+    countAllocation(size);
+    auto result = __libc_memalign(alignment, size);
+    addLiveBytes(result);
+    return result;
+}
+
+
+void *aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return memalign(alignment, size);
+}
+
+
+int posix_memalign(void **ptr, std::size_t alignment, std::size_t size) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0) {
+        return EINVAL;
+    }
+    auto result = memalign(alignment, size);
+    if (result == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = result;
+    return 0;
+}
+
+
+void *valloc(std::size_t size) noexcept {
+    countAllocation(size);
+    auto result = __libc_valloc(size);
+    addLiveBytes(result);
+    return result;
+}
+
+
+void *pvalloc(std::size_t size) noexcept {
+    countAllocation(size);
+    auto result = __libc_pvalloc(size);
+    addLiveBytes(result);
+    return result;
+}
+
+
+void free(void *ptr) noexcept {
+    countDeallocation(ptr);
+    removeLiveBytes(ptr);
+    __libc_free(ptr);
+}
+}
+
+
+auto AllocationCounter::isCountingMalloc() noexcept -> bool {
+    return true;
+}
+
+
+#else
+
+
+auto AllocationCounter::isCountingMalloc() noexcept -> bool {
+    return false;
+}
+
+
+void *operator new(std::size_t size) {
+    countAllocation(size);
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+
+void *operator new[](std::size_t size) {
+    countAllocation(size);
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void *ptr) noexcept {
+    countDeallocation(ptr);
+    std::free(ptr);
+}
+
+
+void operator delete[](void *ptr) noexcept {
+    countDeallocation(ptr);
+    std::free(ptr);
+}
+
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    countDeallocation(ptr);
+    std::free(ptr);
+}
+
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    countDeallocation(ptr);
+    std::free(ptr);
+}
+
+
+#endif
+
@@ -0,0 +1,53 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+#include <cstdint>
+
+
+/// Counts the heap allocations of this process.
+///
+/// On systems with the GNU C library, `malloc` and friends (including the aligned variants) are replaced,
+/// so allocations made by Qt (e.g. for `QString` data) are counted as well. On all other systems, only
+/// allocations made using the global `operator new` are counted.
+///
+/// Allocations and releases are counted symmetrically: a `realloc()` counts as one allocation and, if it
+/// replaces an existing block, as one release.
+///
+class AllocationCounter {
+public:
+    /// Get the number of allocations since the start of the process.
+    ///
+    static auto allocations() noexcept -> std::uint64_t;
+
+    /// Get the number of allocated bytes since the start of the process.
+    ///
+    static auto allocatedBytes() noexcept -> std::uint64_t;
+
+    /// Get the number of released blocks since the start of the process.
+    ///
+    static auto deallocations() noexcept -> std::uint64_t;
+
+    /// Get the number of bytes in blocks that are currently allocated.
+    ///
+    /// This is only tracked if allocations of the C library are counted, see `isCountingMalloc()`.
+    ///
+    static auto liveBytes() noexcept -> std::int64_t;
+
+    /// Test if allocations made by the C library are counted as well.
+    ///
+    static auto isCountingMalloc() noexcept -> bool;
+};
+
@@ -0,0 +1,385 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "Benchmark.hpp"
+
+#include "AllocationCounter.hpp"
+#include "ProcessMemory.hpp"
+
+#include <erbsland/qt/toml/Error.hpp>
+#include <erbsland/qt/toml/InputStream.hpp>
+#include <erbsland/qt/toml/Parser.hpp>
+#include <erbsland/qt/toml/impl/Tokenizer.hpp>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+
+using namespace elqt::toml;
+using namespace elqt::toml::impl;
+
+
+namespace {
+
+
+/// Documents up to this size get one additional, unmeasured warm-up iteration.
+///
+constexpr qint64 cWarmUpLimit = 0x1000000;
+
+
+/// The size of the heap header of a `QString` on 64-bit systems, used to estimate the size of duplicate keys.
+///
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+constexpr qint64 cStringHeaderSize = 16;
+#else
+constexpr qint64 cStringHeaderSize = 24;
+#endif
+
+
+auto formatRate(double value) -> std::string {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1);
+    if (value >= 1'000'000'000.0) {
+        text << (value / 1'000'000'000.0) << "G";
+    } else if (value >= 1'000'000.0) {
+        text << (value / 1'000'000.0) << "M";
+    } else if (value >= 1'000.0) {
+        text << (value / 1'000.0) << "k";
+    } else {
+        text << value;
+    }
+    return text.str();
+}
+
+
+}
+
+
+Benchmark::Benchmark(BenchmarkOptions options)
+    : _options{std::move(options)} {
+}
+
+
+void Benchmark::runOrThrow() {
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        throw Error(QStringLiteral("Could not create a temporary directory: %1").arg(directory.errorString()));
+    }
+    std::cout << "Allocation counting: "
+        << (AllocationCounter::isCountingMalloc() ? "malloc and operator new" : "operator new only") << "\n";
+    std::cout << "Peak RSS: "
+        << (ProcessMemory::resetPeak() ? "per measurement" : "whole process") << "\n\n";
+    writeHeader();
+    for (auto size : _options.sizes) {
+        for (auto kind : _options.kinds) {
+            const auto name = QStringLiteral("%1/%2").arg(DocumentGenerator::kindName(kind), sizeLabel(size));
+            const auto path = QDir{directory.path()}.filePath(
+                QStringLiteral("%1-%2.toml").arg(DocumentGenerator::kindName(kind), sizeLabel(size)));
+            const auto bytes = DocumentGenerator::writeFileOrThrow(path, kind, size);
+            runDocumentOrThrow(path, name, bytes);
+            QFile::remove(path);
+        }
+    }
+}
+
+
+auto Benchmark::stageName(BenchmarkStage stage) -> QString {
+    switch (stage) {
+    case BenchmarkStage::InputStream:
+        return QStringLiteral("InputStream");
+    case BenchmarkStage::InputStreamFromData:
+        return QStringLiteral("InputStream*");
+    case BenchmarkStage::Tokenizer:
+        return QStringLiteral("Tokenizer");
+    case BenchmarkStage::Parser:
+        return QStringLiteral("Parser");
+    case BenchmarkStage::Teardown:
+        return QStringLiteral("Teardown");
+    }
+    return {};
+}
+
+
+auto Benchmark::sizeLabel(qint64 size) -> QString {
+    if (size >= 0x100000 && size % 0x100000 == 0) {
+        return QStringLiteral("%1MB").arg(size / 0x100000);
+    }
+    if (size >= 0x400 && size % 0x400 == 0) {
+        return QStringLiteral("%1KB").arg(size / 0x400);
+    }
+    return QStringLiteral("%1B").arg(size);
+}
+
+
+auto Benchmark::countValues(const ValuePtr &value) -> qint64 {
+    qint64 count = 1;
+    if (value->isTable()) {
+        for (const auto &[key, tableValue] : value->toTable()) {
+            count += countValues(tableValue);
+        }
+    } else if (value->isArray()) {
+        for (const auto &arrayValue : value->toArray()) {
+            count += countValues(arrayValue);
+        }
+    }
+    return count;
+}
+
+
+void Benchmark::runDocumentOrThrow(const QString &path, const QString &name, qint64 bytes) {
+    const auto specification = _options.specification;
+    // Parse the document once, to verify it and to get the number of values.
+    qint64 values = 0;
+    {
+        Parser parser{specification};
+        values = countValues(parser.parseFileOrThrow(path));
+    }
+    writeResult(measure(name, BenchmarkStage::InputStream, bytes, values, [&path]() {
+        auto inputStream = InputStream::createFromFileOrThrow(path);
+        while (!inputStream->atEnd()) {
+            inputStream->readOrThrow();
+        }
+    }));
+    {
+        // Decoding the same data from memory shows the overhead of reading the file through `QIODevice`.
+        QFile file{path};
+        if (!file.open(QIODevice::ReadOnly)) {
+            throw Error::createIO(path, file);
+        }
+        const auto data = file.readAll();
+        file.close();
+        writeResult(measure(name, BenchmarkStage::InputStreamFromData, bytes, values, [&data]() {
+            auto inputStream = InputStream::createFromString(data);
+            while (!inputStream->atEnd()) {
+                inputStream->readOrThrow();
+            }
+        }));
+    }
+    writeResult(measure(name, BenchmarkStage::Tokenizer, bytes, values, [&path, specification]() {
+        auto inputStream = InputStream::createFromFileOrThrow(path);
+        Tokenizer tokenizer{specification};
+        tokenizer.startWithStream(inputStream);
+        while (tokenizer.read().type() != TokenType::EndOfDocument) {
+        }
+    }));
+    writeTokenCounts(path);
+    writeResult(measure(name, BenchmarkStage::Parser, bytes, values, [&path, specification]() {
+        Parser parser{specification};
+        auto document = parser.parseFileOrThrow(path);
+    }));
+    writeMemoryStatistics(path, values);
+    writeResult(measureTeardown(name, path, bytes, values));
+}
+
+
+void Benchmark::writeMemoryStatistics(const QString &path, qint64 values) const {
+    ValuePtr value;
+    const auto liveBytesBefore = AllocationCounter::liveBytes();
+    {
+        Parser parser{_options.specification};
+        value = parser.parseFileOrThrow(path);
+    }
+    if (AllocationCounter::isCountingMalloc()) {
+        const auto retainedBytes = static_cast<double>(AllocationCounter::liveBytes() - liveBytesBefore);
+        std::cout << std::left << std::setw(28) << "" << "-> " << std::fixed << std::setprecision(1)
+            << (retainedBytes / 0x100000) << "MB retained by the document, "
+            << (retainedBytes / static_cast<double>(values)) << " bytes per value" << std::endl;
+    }
+    KeyStatistics statistics;
+    collectKeyStatistics(value, statistics);
+    std::cout << std::left << std::setw(28) << "" << "-> " << formatRate(static_cast<double>(statistics.keyCount))
+        << " table keys, " << formatRate(static_cast<double>(statistics.uniqueKeys.size())) << " distinct, "
+        << std::fixed << std::setprecision(1) << (static_cast<double>(statistics.duplicateBytes) / 0x100000)
+        << "MB in duplicated key strings" << std::endl;
+}
+
+
+void Benchmark::collectKeyStatistics(const ValuePtr &value, KeyStatistics &statistics) {
+    if (value->isTable()) {
+        for (const auto &[key, tableValue] : value->toTable()) {
+            statistics.keyCount += 1;
+            const auto isNewText = !statistics.uniqueKeys.contains(key);
+            if (isNewText) {
+                statistics.uniqueKeys.insert(key);
+            }
+            // Keys sharing the same data (e.g. from an interning pool) don't count as duplicates.
+            if (statistics.dataPointers.insert(key.constData()).second && !isNewText) {
+                statistics.duplicateBytes += cStringHeaderSize + (key.size() + 1) * static_cast<qint64>(sizeof(QChar));
+            }
+            collectKeyStatistics(tableValue, statistics);
+        }
+    } else if (value->isArray()) {
+        for (const auto &arrayValue : value->toArray()) {
+            collectKeyStatistics(arrayValue, statistics);
+        }
+    }
+}
+
+
+void Benchmark::writeTokenCounts(const QString &path) const {
+    auto inputStream = InputStream::createFromFileOrThrow(path);
+    Tokenizer tokenizer{_options.specification};
+    tokenizer.startWithStream(inputStream);
+    qint64 tokenCount = 0;
+    qint64 triviaCount = 0;
+    for (auto token = tokenizer.read(); token.type() != TokenType::EndOfDocument; token = tokenizer.read()) {
+        tokenCount += 1;
+        switch (token.type()) {
+        case TokenType::Whitespace:
+        case TokenType::Comment:
+        case TokenType::NewLine:
+            triviaCount += 1;
+            break;
+        default:
+            break;
+        }
+    }
+    const auto triviaPercent = (tokenCount > 0 ? 100.0 * static_cast<double>(triviaCount) / tokenCount : 0.0);
+    std::cout << std::left << std::setw(28) << "" << "-> " << formatRate(static_cast<double>(tokenCount))
+        << " tokens, " << std::fixed << std::setprecision(1) << triviaPercent
+        << "% whitespace, comment and newline tokens" << std::endl;
+}
+
+
+auto Benchmark::measure(
+    const QString &document,
+    BenchmarkStage stage,
+    qint64 bytes,
+    qint64 values,
+    const std::function<void()> &function) -> BenchmarkResult {
+
+    if (bytes <= cWarmUpLimit) {
+        function();
+    }
+    ProcessMemory::resetPeak();
+    const auto allocationsBefore = AllocationCounter::allocations();
+    const auto startTime = std::chrono::steady_clock::now();
+    auto elapsedTime = std::chrono::duration<double>{};
+    int iterations = 0;
+    do {
+        function();
+        iterations += 1;
+        elapsedTime = std::chrono::steady_clock::now() - startTime;
+    } while (elapsedTime < _options.minimumTime);
+    const auto allocations = AllocationCounter::allocations() - allocationsBefore;
+
+    BenchmarkResult result;
+    result.document = document;
+    result.stage = stage;
+    result.bytes = bytes;
+    result.values = values;
+    result.iterations = iterations;
+    result.secondsPerIteration = elapsedTime.count() / iterations;
+    result.allocationsPerIteration = static_cast<double>(allocations) / iterations;
+    result.peakResidentBytes = ProcessMemory::peakResidentBytes();
+    return result;
+}
+
+
+auto Benchmark::measureTeardown(
+    const QString &document,
+    const QString &path,
+    qint64 bytes,
+    qint64 values) -> BenchmarkResult {
+
+    const auto startTime = std::chrono::steady_clock::now();
+    auto teardownTime = std::chrono::duration<double>{};
+    std::uint64_t deallocations = 0;
+    std::int64_t peakResidentBytes = -1;
+    int iterations = 0;
+    do {
+        ValuePtr value;
+        {
+            Parser parser{_options.specification};
+            value = parser.parseFileOrThrow(path);
+        }
+        // Reset the peak after parsing, so it isn't the peak of the parser. If this isn't possible, the
+        // peak isn't reported for this stage.
+        const auto isPeakReset = ProcessMemory::resetPeak();
+        const auto deallocationsBefore = AllocationCounter::deallocations();
+        const auto teardownStartTime = std::chrono::steady_clock::now();
+        value.reset();
+        teardownTime += std::chrono::steady_clock::now() - teardownStartTime;
+        deallocations += AllocationCounter::deallocations() - deallocationsBefore;
+        if (isPeakReset) {
+            peakResidentBytes = std::max(peakResidentBytes, ProcessMemory::peakResidentBytes());
+        }
+        iterations += 1;
+    } while (std::chrono::steady_clock::now() - startTime < _options.minimumTime);
+
+    BenchmarkResult result;
+    result.document = document;
+    result.stage = BenchmarkStage::Teardown;
+    result.bytes = bytes;
+    result.values = values;
+    result.iterations = iterations;
+    result.secondsPerIteration = teardownTime.count() / iterations;
+    result.allocationsPerIteration = static_cast<double>(deallocations) / iterations;
+    result.peakResidentBytes = peakResidentBytes;
+    return result;
+}
+
+
+void Benchmark::writeHeader() {
+    std::cout << std::left
+        << std::setw(28) << "Document"
+        << std::setw(13) << "Stage"
+        << std::right
+        << std::setw(10) << "Bytes"
+        << std::setw(10) << "Values"
+        << std::setw(8) << "Iter."
+        << std::setw(11) << "MB/s"
+        << std::setw(11) << "Values/s"
+        << std::setw(12) << "Peak RSS"
+        << std::setw(13) << "Allocs/Value"
+        << std::endl;
+    std::cout << std::string(116, '-') << std::endl;
+}
+
+
+void Benchmark::writeResult(const BenchmarkResult &result) {
+    const auto megaBytesPerSecond = static_cast<double>(result.bytes) / 0x100000 / result.secondsPerIteration;
+    const auto valuesPerSecond = static_cast<double>(result.values) / result.secondsPerIteration;
+    const auto allocationsPerValue = result.allocationsPerIteration / static_cast<double>(result.values);
+    std::ostringstream peakText;
+    if (result.peakResidentBytes < 0) {
+        peakText << "n/a";
+    } else {
+        peakText << std::fixed << std::setprecision(1)
+            << (static_cast<double>(result.peakResidentBytes) / 0x100000) << "MB";
+    }
+    std::cout << std::left
+        << std::setw(28) << result.document.toStdString()
+        << std::setw(13) << stageName(result.stage).toStdString()
+        << std::right
+        << std::setw(10) << formatRate(static_cast<double>(result.bytes))
+        << std::setw(10) << formatRate(static_cast<double>(result.values))
+        << std::setw(8) << result.iterations
+        << std::fixed << std::setprecision(1)
+        << std::setw(11) << megaBytesPerSecond
+        << std::setw(11) << formatRate(valuesPerSecond)
+        << std::setw(12) << peakText.str()
+        << std::setprecision(2)
+        << std::setw(13) << allocationsPerValue
+        << std::endl;
+}
+
@@ -0,0 +1,122 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+#include "DocumentGenerator.hpp"
+
+#include <erbsland/qt/toml/Specification.hpp>
+#include <erbsland/qt/toml/Value.hpp>
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+
+/// The options for a benchmark run.
+///
+struct BenchmarkOptions {
+    std::vector<DocumentKind> kinds; ///< The kinds of documents to test.
+    std::vector<qint64> sizes; ///< The target sizes of the generated documents in bytes.
+    std::chrono::duration<double> minimumTime{1.0}; ///< The minimum time to repeat each measurement.
+    elqt::toml::Specification specification{elqt::toml::Specification::Version_1_0}; ///< The TOML specification.
+    std::vector<int> lookupTableSizes; ///< The number of keys in the tables for the lookup measurements.
+};
+
+
+/// The stage of the library that is measured.
+///
+enum class BenchmarkStage : int {
+    InputStream, ///< Only decode the characters using `InputStream`.
+    InputStreamFromData, ///< Decode the characters from a document that is already in memory.
+    Tokenizer, ///< Only read all tokens using `impl::Tokenizer`.
+    Parser, ///< Build the complete value tree using `Parser`.
+    Teardown, ///< Destroy a parsed value tree.
+};
+
+
+/// The result of a single measurement.
+///
+struct BenchmarkResult {
+    QString document; ///< The name of the document.
+    BenchmarkStage stage{}; ///< The measured stage.
+    qint64 bytes{}; ///< The size of the document in bytes.
+    qint64 values{}; ///< The number of values in the document.
+    int iterations{}; ///< The number of iterations.
+    double secondsPerIteration{}; ///< The average time for one iteration.
+    double allocationsPerIteration{}; ///< The average number of allocations (or releases for teardown) for one iteration.
+    std::int64_t peakResidentBytes{}; ///< The peak resident set size while measuring, or -1 if unknown.
+};
+
+
+/// Statistics about the table keys in a document.
+///
+struct KeyStatistics {
+    qint64 keyCount{}; ///< The total number of table keys.
+    QSet<QString> uniqueKeys; ///< The distinct key texts.
+    std::unordered_set<const QChar*> dataPointers; ///< The string data pointers of all seen keys.
+    qint64 duplicateBytes{}; ///< The estimated heap size of keys that duplicate an existing key.
+};
+
+
+/// The benchmark for the parser and its stages.
+///
+class Benchmark {
+public:
+    /// Create a new benchmark.
+    ///
+    explicit Benchmark(BenchmarkOptions options);
+
+public:
+    /// Generate all documents and run all measurements.
+    ///
+    /// The results are written to the console while the benchmark is running.
+    ///
+    /// @throws Error if a document can't be written or parsed.
+    ///
+    void runOrThrow();
+
+public:
+    /// Get the name of a stage.
+    ///
+    static auto stageName(BenchmarkStage stage) -> QString;
+
+    /// Get a short label for a document size.
+    ///
+    static auto sizeLabel(qint64 size) -> QString;
+
+    /// Count all values in a value tree, including the tables and arrays.
+    ///
+    static auto countValues(const elqt::toml::ValuePtr &value) -> qint64;
+
+private:
+    void runDocumentOrThrow(const QString &path, const QString &name, qint64 bytes);
+    void writeTokenCounts(const QString &path) const;
+    void writeMemoryStatistics(const QString &path, qint64 values) const;
+    static void collectKeyStatistics(const elqt::toml::ValuePtr &value, KeyStatistics &statistics);
+    auto measure(const QString &document, BenchmarkStage stage, qint64 bytes, qint64 values,
+        const std::function<void()> &function) -> BenchmarkResult;
+    auto measureTeardown(const QString &document, const QString &path, qint64 bytes, qint64 values) -> BenchmarkResult;
+    static void writeHeader();
+    static void writeResult(const BenchmarkResult &result);
+
+private:
+    BenchmarkOptions _options; ///< The options for this run.
+};
+
@@ -0,0 +1,219 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "DocumentGenerator.hpp"
+
+#include <erbsland/qt/toml/Error.hpp>
+
+#include <QtCore/QFile>
+
+
+using elqt::toml::Error;
+
+
+namespace {
+
+
+/// The number of elements in one generated array of inline tables.
+///
+constexpr int cInlineTablesPerArray = 10000;
+
+
+void appendSmallTable(QByteArray &data, qint64 index) {
+    data.append("[table_").append(QByteArray::number(index)).append("]\n");
+    data.append("name = \"Table ").append(QByteArray::number(index)).append("\"\n");
+    data.append("id = ").append(QByteArray::number(index)).append("\n");
+    data.append("enabled = ").append(index % 2 == 0 ? "true" : "false").append("\n");
+    data.append("ratio = 0.").append(QByteArray::number(index % 1000)).append("\n");
+    data.append("created = 2023-05-").append(QByteArray::number(10 + index % 18)).append("T08:12:00Z\n\n");
+}
+
+
+void appendDottedKey(QByteArray &data, qint64 index) {
+    data.append("level0_").append(QByteArray::number(index / 4096));
+    data.append(".level1_").append(QByteArray::number((index / 512) % 8));
+    data.append(".level2_").append(QByteArray::number((index / 64) % 8));
+    data.append(".level3_").append(QByteArray::number((index / 8) % 8));
+    data.append(".level4.key_").append(QByteArray::number(index % 8));
+    data.append(" = ").append(QByteArray::number(index)).append("\n");
+}
+
+
+void appendInlineTable(QByteArray &data, qint64 index) {
+    if (index % cInlineTablesPerArray == 0) {
+        if (index > 0) {
+            data.append("]\n");
+        }
+        data.append("items_").append(QByteArray::number(index / cInlineTablesPerArray)).append(" = [\n");
+    }
+    data.append("    {id = ").append(QByteArray::number(index));
+    data.append(", name = \"item ").append(QByteArray::number(index));
+    data.append("\", x = ").append(QByteArray::number(static_cast<double>(index) * 0.25, 'f', 2));
+    data.append(", y = -").append(QByteArray::number(index % 97)).append(".5");
+    data.append(", active = true},\n");
+}
+
+
+void appendStrings(QByteArray &data, qint64 index) {
+    const auto number = QByteArray::number(index);
+    data.append("# Comment for the string block ").append(number).append(".\n");
+    data.append("text_").append(number).append(" = \"The quick brown fox jumps over the lazy dog. ");
+    data.append("\\\"Quoted\\\" \\t tab, \\\\ backslash and a unicode \\u00e9 escape.\"\n");
+    data.append("path_").append(number).append(" = 'C:\\Users\\example\\Documents\\file_").append(number).append(".txt'\n");
+    data.append("multi_").append(number).append(" = \"\"\"\n");
+    data.append("    Lorem ipsum dolor sit amet, consectetur adipiscing elit, \\\n");
+    data.append("    sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\n");
+    data.append("    Ut enim ad minim veniam, quis nostrud exercitation ullamco.\"\"\"\n");
+    data.append("literal_").append(number).append(" = '''\n");
+    data.append("Duis aute irure dolor in reprehenderit in voluptate velit esse.\n");
+    data.append("Excepteur sint occaecat cupidatat non proident.'''\n\n");
+}
+
+
+void appendNumericData(QByteArray &data, qint64 index) {
+    const auto number = QByteArray::number(index);
+    data.append("row_").append(number).append(" = [");
+    data.append(number);
+    data.append(", 0x").append(QByteArray::number(index * 7919, 16));
+    data.append(", ").append(QByteArray::number(static_cast<double>(index) * 1.0001, 'f', 4));
+    data.append(", ").append(QByteArray::number(static_cast<double>(index % 1000) * 1.5e-7, 'e', 6));
+    data.append(", 2023-").append(QByteArray::number(10 + index % 3)).append("-");
+    data.append(QByteArray::number(10 + index % 19)).append("T12:");
+    data.append(QByteArray::number(10 + index % 50)).append(":00.250+02:00");
+    data.append(", 1979-05-27, 07:32:").append(QByteArray::number(10 + index % 50)).append("]\n");
+}
+
+
+void appendFloatArray(QByteArray &data, qint64 index) {
+    const auto value = static_cast<double>(index % 10007);
+    data.append("thresholds_").append(QByteArray::number(index)).append(" = [");
+    data.append(QByteArray::number(value * 0.125, 'f', 3)).append(", ");
+    data.append(QByteArray::number(-value * 1.75e-5, 'e', 8)).append(", ");
+    data.append(QByteArray::number(value * 3.3e12, 'E', 4)).append(", ");
+    data.append(QByteArray::number(value * 0.1, 'g', 17)).append("e0, ");
+    data.append("1_000.000_").append(QByteArray::number(100 + index % 900)).append(", ");
+    data.append("6.626e-34, -2E-2, 5e+22, inf, nan]\n");
+}
+
+
+void appendArrayTable(QByteArray &data, qint64 index) {
+    const auto number = QByteArray::number(index);
+    data.append("[[entries]]\n");
+    data.append("name = \"entry ").append(number).append("\"\n");
+    data.append("type = \"").append(index % 3 == 0 ? "host" : "service").append("\"\n");
+    data.append("value = ").append(number).append("\n");
+    data.append("tags = [\"a\", \"b\"]\n");
+    data.append("owner = {name = \"team ").append(QByteArray::number(index % 10)).append("\", type = \"group\"}\n\n");
+}
+
+
+void appendRecord(QByteArray &data, DocumentKind kind, qint64 index) {
+    switch (kind) {
+    case DocumentKind::SmallTables:
+        appendSmallTable(data, index);
+        break;
+    case DocumentKind::DottedKeys:
+        appendDottedKey(data, index);
+        break;
+    case DocumentKind::InlineTableArrays:
+        appendInlineTable(data, index);
+        break;
+    case DocumentKind::Strings:
+        appendStrings(data, index);
+        break;
+    case DocumentKind::NumericData:
+        appendNumericData(data, index);
+        break;
+    case DocumentKind::FloatArrays:
+        appendFloatArray(data, index);
+        break;
+    case DocumentKind::ArrayOfTables:
+        appendArrayTable(data, index);
+        break;
+    }
+}
+
+
+void appendDocumentEnd(QByteArray &data, DocumentKind kind, qint64 recordCount) {
+    if (kind == DocumentKind::InlineTableArrays && recordCount > 0) {
+        data.append("]\n");
+    }
+}
+
+
+}
+
+
+auto DocumentGenerator::allKinds() -> std::vector<DocumentKind> {
+    return {
+        DocumentKind::SmallTables,
+        DocumentKind::DottedKeys,
+        DocumentKind::InlineTableArrays,
+        DocumentKind::Strings,
+        DocumentKind::NumericData,
+        DocumentKind::FloatArrays,
+        DocumentKind::ArrayOfTables,
+    };
+}
+
+
+auto DocumentGenerator::kindName(DocumentKind kind) -> QString {
+    switch (kind) {
+    case DocumentKind::SmallTables:
+        return QStringLiteral("small-tables");
+    case DocumentKind::DottedKeys:
+        return QStringLiteral("dotted-keys");
+    case DocumentKind::InlineTableArrays:
+        return QStringLiteral("inline-table-arrays");
+    case DocumentKind::Strings:
+        return QStringLiteral("strings");
+    case DocumentKind::NumericData:
+        return QStringLiteral("numeric-data");
+    case DocumentKind::FloatArrays:
+        return QStringLiteral("float-arrays");
+    case DocumentKind::ArrayOfTables:
+        return QStringLiteral("array-of-tables");
+    }
+    return {};
+}
+
+
+auto DocumentGenerator::generate(DocumentKind kind, qint64 targetSize) -> QByteArray {
+    QByteArray data;
+    data.reserve(static_cast<decltype(data.size())>(targetSize + 1024));
+    data.append("# Synthetic benchmark document: ").append(kindName(kind).toUtf8()).append("\n\n");
+    qint64 index = 0;
+    while (data.size() < targetSize) {
+        appendRecord(data, kind, index);
+        index += 1;
+    }
+    appendDocumentEnd(data, kind, index);
+    return data;
+}
+
+
+auto DocumentGenerator::writeFileOrThrow(const QString &path, DocumentKind kind, qint64 targetSize) -> qint64 {
+    const auto data = generate(kind, targetSize);
+    QFile file{path};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw Error::createIO(path, file);
+    }
+    if (file.write(data) != data.size()) {
+        throw Error::createIO(path, file);
+    }
+    file.close();
+    return data.size();
+}
+
@@ -0,0 +1,68 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include <vector>
+
+
+/// The kind of synthetic document to generate.
+///
+enum class DocumentKind : int {
+    SmallTables, ///< Many small tables with a few values each.
+    DottedKeys, ///< Deep dotted keys, creating a deep structure of implicit tables.
+    InlineTableArrays, ///< Huge arrays of inline tables.
+    Strings, ///< Mostly basic, literal and multi-line strings with escape sequences.
+    NumericData, ///< Rows of integers, floats and date/time values, like exported data tables.
+    FloatArrays, ///< Arrays of floats in all notations, like telemetry threshold files.
+    ArrayOfTables, ///< An array of tables, where the same keys repeat in every element.
+};
+
+
+/// Generator for synthetic TOML documents used by the benchmark.
+///
+class DocumentGenerator {
+public:
+    /// Get a list with all document kinds.
+    ///
+    static auto allKinds() -> std::vector<DocumentKind>;
+
+    /// Get the name of a document kind.
+    ///
+    static auto kindName(DocumentKind kind) -> QString;
+
+    /// Generate a document.
+    ///
+    /// The generator appends complete records until the document reaches at least `targetSize` bytes.
+    ///
+    /// @param kind The kind of document to generate.
+    /// @param targetSize The minimum size of the document in bytes.
+    /// @return The UTF-8 encoded document.
+    ///
+    static auto generate(DocumentKind kind, qint64 targetSize) -> QByteArray;
+
+    /// Generate a document and write it into a file.
+    ///
+    /// @param path The path of the file to write.
+    /// @param kind The kind of document to generate.
+    /// @param targetSize The minimum size of the document in bytes.
+    /// @return The size of the written file in bytes.
+    /// @throws Error if there was a problem writing the file.
+    ///
+    static auto writeFileOrThrow(const QString &path, DocumentKind kind, qint64 targetSize) -> qint64;
+};
+
@@ -0,0 +1,80 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "ProcessMemory.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <cstring>
+#else
+#include <sys/resource.h>
+#endif
+
+
+auto ProcessMemory::peakResidentBytes() noexcept -> std::int64_t {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return static_cast<std::int64_t>(counters.PeakWorkingSetSize);
+#elif defined(__linux__)
+    // Read "VmHWM" from the status file, as this value can be reset, unlike the one from `getrusage`.
+    auto file = std::fopen("/proc/self/status", "r");
+    if (file == nullptr) {
+        return -1;
+    }
+    std::int64_t result = -1;
+    char line[256];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        long long kiloBytes = 0;
+        if (std::strncmp(line, "VmHWM:", 6) == 0 && std::sscanf(line + 6, "%lld", &kiloBytes) == 1) {
+            result = static_cast<std::int64_t>(kiloBytes) * 1024;
+            break;
+        }
+    }
+    std::fclose(file);
+    return result;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::int64_t>(usage.ru_maxrss); // bytes on macOS
+#else
+    return static_cast<std::int64_t>(usage.ru_maxrss) * 1024; // kilobytes everywhere else
+#endif
+#endif
+}
+
+
+auto ProcessMemory::resetPeak() noexcept -> bool {
+#if defined(__linux__)
+    auto file = std::fopen("/proc/self/clear_refs", "w");
+    if (file == nullptr) {
+        return false;
+    }
+    auto success = std::fputs("5", file) >= 0;
+    success &= (std::fclose(file) == 0);
+    return success;
+#else
+    return false;
+#endif
+}
+
@@ -0,0 +1,39 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+#include <cstdint>
+
+
+/// Access to the memory statistics of this process.
+///
+class ProcessMemory {
+public:
+    /// Get the peak resident set size of this process in bytes.
+    ///
+    /// @return The peak resident set size, or `-1` if it can't be determined on this platform.
+    ///
+    static auto peakResidentBytes() noexcept -> std::int64_t;
+
+    /// Reset the peak resident set size to the current resident set size.
+    ///
+    /// This is only supported on Linux. On all other platforms, the peak is kept for the whole
+    /// lifetime of the process.
+    ///
+    /// @return `true` if the peak was reset.
+    ///
+    static auto resetPeak() noexcept -> bool;
+};
+
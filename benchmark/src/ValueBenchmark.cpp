@@ -0,0 +1,256 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "ValueBenchmark.hpp"
+
+#include <erbsland/qt/toml/Error.hpp>
+#include <erbsland/qt/toml/Parser.hpp>
+
+#include <QtCore/QDir>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+using namespace elqt::toml;
+
+
+namespace {
+
+
+/// The size of the documents for the JSON export measurements.
+///
+constexpr qint64 cJsonExportDocumentSize = 0x100000;
+
+
+}
+
+
+ValueBenchmark::ValueBenchmark(BenchmarkOptions options)
+    : _options{std::move(options)} {
+}
+
+
+void ValueBenchmark::runOrThrow() {
+    std::cout << "\n";
+    writeHeader();
+    for (auto tableSize : _options.lookupTableSizes) {
+        runLookups(tableSize);
+    }
+    runPathLookups();
+    runClones();
+    runJsonExportOrThrow(DocumentKind::ArrayOfTables);
+    runJsonExportOrThrow(DocumentKind::NumericData);
+}
+
+
+void ValueBenchmark::runLookups(int tableSize) {
+    auto table = Value::createTable(Value::Source::ExplicitTable);
+    QStringList keys;
+    QStringList missingKeys;
+    for (int i = 0; i < tableSize; ++i) {
+        keys.append(QStringLiteral("key_%1").arg(i));
+        missingKeys.append(QStringLiteral("missing_%1").arg(i));
+        table->setValue(keys.back(), Value::createInteger(i));
+    }
+    // Access the keys in random order, so the measurement doesn't profit from the insertion order.
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+    const auto subject = QStringLiteral("table/%1 keys").arg(tableSize);
+    measure(subject, QStringLiteral("valueFromKey()"), keys.size(), [&table, &keys]() -> qint64 {
+        qint64 sum = 0;
+        for (const auto &key : keys) {
+            sum += table->valueFromKey(key)->toInteger();
+        }
+        return sum;
+    });
+    measure(subject, QStringLiteral("value()"), keys.size(), [&table, &keys]() -> qint64 {
+        qint64 sum = 0;
+        for (const auto &key : keys) {
+            sum += table->value(key)->toInteger();
+        }
+        return sum;
+    });
+    measure(subject, QStringLiteral("hasKey()"), keys.size(), [&table, &keys]() -> qint64 {
+        qint64 count = 0;
+        for (const auto &key : keys) {
+            count += (table->hasKey(key) ? 1 : 0);
+        }
+        return count;
+    });
+    measure(subject, QStringLiteral("value() missing"), missingKeys.size(), [&table, &missingKeys]() -> qint64 {
+        qint64 count = 0;
+        for (const auto &key : missingKeys) {
+            count += (table->value(key) == nullptr ? 1 : 0);
+        }
+        return count;
+    });
+}
+
+
+void ValueBenchmark::runPathLookups() {
+    // A structure like a typical service configuration, accessed with dotted paths.
+    constexpr int sectionCount = 100;
+    auto root = Value::createTable(Value::Source::ExplicitTable);
+    QStringList paths;
+    for (int i = 0; i < sectionCount; ++i) {
+        auto limits = Value::createTable(Value::Source::ExplicitTable);
+        limits->setValue(QStringLiteral("max_body"), Value::createInteger(i));
+        limits->setValue(QStringLiteral("timeout"), Value::createInteger(i * 2));
+        auto http = Value::createTable(Value::Source::ExplicitTable);
+        http->setValue(QStringLiteral("limits"), limits);
+        auto section = Value::createTable(Value::Source::ExplicitTable);
+        section->setValue(QStringLiteral("http"), http);
+        root->setValue(QStringLiteral("section_%1").arg(i), section);
+        paths.append(QStringLiteral("section_%1.http.limits.max_body").arg(i));
+        paths.append(QStringLiteral("section_%1.http.limits.timeout").arg(i));
+    }
+    std::shuffle(paths.begin(), paths.end(), std::mt19937{42});
+    // The paths split in advance, as a baseline for pre-split paths. The chained `valueFromKey()` calls still
+    // copy a `ValuePtr` at each level, so a path that caches the resolved value would be faster than this.
+    std::vector<QStringList> splitPaths;
+    splitPaths.reserve(static_cast<std::size_t>(paths.size()));
+    for (const auto &path : paths) {
+        splitPaths.push_back(path.split(QChar{'.'}));
+    }
+    const auto subject = QStringLiteral("path/depth 4");
+    measure(subject, QStringLiteral("integerValue()"), paths.size(), [&root, &paths]() -> qint64 {
+        qint64 sum = 0;
+        for (const auto &path : paths) {
+            sum += root->integerValue(path);
+        }
+        return sum;
+    });
+    measure(subject, QStringLiteral("value()"), paths.size(), [&root, &paths]() -> qint64 {
+        qint64 sum = 0;
+        for (const auto &path : paths) {
+            sum += root->value(path)->toInteger();
+        }
+        return sum;
+    });
+    measure(subject, QStringLiteral("valueFromKey() chain"), paths.size(), [&root, &splitPaths]() -> qint64 {
+        qint64 sum = 0;
+        for (const auto &keys : splitPaths) {
+            auto value = root;
+            for (const auto &key : keys) {
+                value = value->valueFromKey(key);
+            }
+            sum += value->toInteger();
+        }
+        return sum;
+    });
+}
+
+
+void ValueBenchmark::runClones() {
+    // A base configuration, that is cloned for each tenant and modified in one place.
+    constexpr int sectionCount = 1000;
+    constexpr int valuesPerSection = 10;
+    auto base = Value::createTable(Value::Source::ExplicitTable);
+    for (int i = 0; i < sectionCount; ++i) {
+        auto section = Value::createTable(Value::Source::ExplicitTable);
+        for (int j = 0; j < valuesPerSection; ++j) {
+            section->setValue(QStringLiteral("value_%1").arg(j), Value::createInteger(j));
+        }
+        section->setValue(QStringLiteral("name"), Value::createString(QStringLiteral("Section %1").arg(i)));
+        base->setValue(QStringLiteral("section_%1").arg(i), section);
+    }
+    const auto subject = QStringLiteral("config/%1 values").arg(Benchmark::countValues(base));
+    measure(subject, QStringLiteral("clone()"), 1, [&base]() -> qint64 {
+        auto clone = base->clone();
+        return static_cast<qint64>(clone->size());
+    });
+    const auto sectionKey = QStringLiteral("section_%1").arg(sectionCount / 2);
+    const auto valueKey = QStringLiteral("value_0");
+    measure(subject, QStringLiteral("clone() + setValue()"), 1, [&base, &sectionKey, &valueKey]() -> qint64 {
+        auto clone = base->clone();
+        clone->valueFromKey(sectionKey)->setValue(valueKey, Value::createInteger(100));
+        return static_cast<qint64>(clone->size());
+    });
+}
+
+
+void ValueBenchmark::runJsonExportOrThrow(DocumentKind kind) {
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        throw Error(QStringLiteral("Could not create a temporary directory: %1").arg(directory.errorString()));
+    }
+    const auto path = QDir{directory.path()}.filePath(QStringLiteral("export.toml"));
+    DocumentGenerator::writeFileOrThrow(path, kind, cJsonExportDocumentSize);
+    Parser parser{_options.specification};
+    const auto document = parser.parseFileOrThrow(path);
+    const auto values = Benchmark::countValues(document);
+    const auto subject = QStringLiteral("json/%1 %2").arg(
+        DocumentGenerator::kindName(kind), Benchmark::sizeLabel(cJsonExportDocumentSize));
+    // The operation is the export of one value, to make the results comparable between documents.
+    measure(subject, QStringLiteral("toJson() compact"), values, [&document]() -> qint64 {
+        return QJsonDocument{document->toJson().toObject()}.toJson(QJsonDocument::Compact).size();
+    });
+    measure(subject, QStringLiteral("toJson() indented"), values, [&document]() -> qint64 {
+        return QJsonDocument{document->toJson().toObject()}.toJson(QJsonDocument::Indented).size();
+    });
+    measure(subject, QStringLiteral("toUnitTestJson()"), values, [&document]() -> qint64 {
+        return QJsonDocument{document->toUnitTestJson().toObject()}.toJson(QJsonDocument::Compact).size();
+    });
+}
+
+
+void ValueBenchmark::measure(
+    const QString &subject,
+    const QString &operation,
+    qint64 operationsPerPass,
+    const std::function<qint64()> &pass) {
+
+    _sink += pass(); // warm-up
+    const auto startTime = std::chrono::steady_clock::now();
+    auto elapsedTime = std::chrono::duration<double>{};
+    qint64 passes = 0;
+    do {
+        _sink += pass();
+        passes += 1;
+        elapsedTime = std::chrono::steady_clock::now() - startTime;
+    } while (elapsedTime < _options.minimumTime);
+    const auto operations = static_cast<double>(passes * std::max<qint64>(operationsPerPass, 1));
+    const auto nanosecondsPerOperation = elapsedTime.count() * 1'000'000'000.0 / operations;
+    std::cout << std::left
+        << std::setw(28) << subject.toStdString()
+        << std::setw(24) << operation.toStdString()
+        << std::right
+        << std::setw(10) << passes
+        << std::fixed << std::setprecision(1)
+        << std::setw(14) << nanosecondsPerOperation
+        << std::endl;
+}
+
+
+void ValueBenchmark::writeHeader() {
+    std::cout << std::left
+        << std::setw(28) << "Subject"
+        << std::setw(24) << "Operation"
+        << std::right
+        << std::setw(10) << "Passes"
+        << std::setw(14) << "ns/Operation"
+        << std::endl;
+    std::cout << std::string(76, '-') << std::endl;
+}
+
@@ -0,0 +1,54 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+#include "Benchmark.hpp"
+
+#include <erbsland/qt/toml/Value.hpp>
+
+#include <QtCore/QString>
+
+#include <functional>
+
+
+/// The benchmark for operations on existing value trees.
+///
+class ValueBenchmark {
+public:
+    /// Create a new value benchmark.
+    ///
+    explicit ValueBenchmark(BenchmarkOptions options);
+
+public:
+    /// Run all measurements and write the results to the console.
+    ///
+    /// @throws Error if a document can't be written or parsed.
+    ///
+    void runOrThrow();
+
+private:
+    void runLookups(int tableSize);
+    void runPathLookups();
+    void runClones();
+    void runJsonExportOrThrow(DocumentKind kind);
+    void measure(const QString &subject, const QString &operation, qint64 operationsPerPass,
+        const std::function<qint64()> &pass);
+    static void writeHeader();
+
+private:
+    BenchmarkOptions _options; ///< The options for this run.
+    qint64 _sink{}; ///< Collects the results of the passes, so the compiler can't remove them.
+};
+
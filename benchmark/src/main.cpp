@@ -0,0 +1,186 @@
+// Copyright © 2024 Tobias Erbsland. Web: https://erbsland.dev
+// Copyright © 2024 EducateIT GmbH. Web: https://educateit.ch
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "Benchmark.hpp"
+#include "ValueBenchmark.hpp"
+
+#include <erbsland/qt/toml/Error.hpp>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+
+#include <iostream>
+#include <optional>
+
+
+using namespace elqt::toml;
+
+
+namespace {
+
+
+/// The largest document size that can be requested.
+///
+/// Qt 5 limits a `QByteArray` to 2 GiB, and the parser keeps the decoded text in memory as well.
+///
+constexpr qint64 cMaximumSize = 0x40000000;
+
+
+auto parseSize(const QString &text) -> std::optional<qint64> {
+    auto lowerText = text.trimmed().toLower();
+    qint64 factor = 1;
+    QString suffix;
+    while (!lowerText.isEmpty() && lowerText.back().isLetter()) {
+        suffix.prepend(lowerText.back());
+        lowerText.chop(1);
+    }
+    if (suffix == QStringLiteral("k") || suffix == QStringLiteral("kb")) {
+        factor = 0x400;
+    } else if (suffix == QStringLiteral("m") || suffix == QStringLiteral("mb")) {
+        factor = 0x100000;
+    } else if (suffix == QStringLiteral("g") || suffix == QStringLiteral("gb")) {
+        factor = 0x40000000;
+    } else if (!suffix.isEmpty() && suffix != QStringLiteral("b")) {
+        return std::nullopt;
+    }
+    bool ok = false;
+    const auto number = lowerText.trimmed().toLongLong(&ok);
+    if (!ok || number <= 0 || number > cMaximumSize / factor) {
+        return std::nullopt;
+    }
+    return number * factor;
+}
+
+
+auto parseKind(const QString &text) -> std::optional<DocumentKind> {
+    for (auto kind : DocumentGenerator::allKinds()) {
+        if (DocumentGenerator::kindName(kind) == text.trimmed()) {
+            return kind;
+        }
+    }
+    return std::nullopt;
+}
+
+
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    QCoreApplication app{argc, argv};
+    QCoreApplication::setApplicationName(QStringLiteral("benchmark"));
+
+    QCommandLineParser commandLine;
+    commandLine.setApplicationDescription(QStringLiteral("Throughput benchmark for the Erbsland Qt TOML parser."));
+    commandLine.addHelpOption();
+    QCommandLineOption sizesOption{
+        QStringLiteral("sizes"),
+        QStringLiteral("Comma separated list of document sizes with the suffix B, KB, MB or GB, "
+            "up to 1GB (default: 1KB,1MB,100MB)."),
+        QStringLiteral("sizes"),
+        QStringLiteral("1KB,1MB,100MB")};
+    QCommandLineOption kindsOption{
+        QStringLiteral("kinds"),
+        QStringLiteral("Comma separated list of document kinds (default: all). "
+            "Kinds: small-tables, dotted-keys, inline-table-arrays, strings, numeric-data, float-arrays, array-of-tables."),
+        QStringLiteral("kinds")};
+    QCommandLineOption minimumTimeOption{
+        QStringLiteral("min-time"),
+        QStringLiteral("Minimum time in seconds to repeat each measurement (default: 1.0)."),
+        QStringLiteral("seconds"),
+        QStringLiteral("1.0")};
+    QCommandLineOption lookupSizesOption{
+        QStringLiteral("lookup-sizes"),
+        QStringLiteral("Comma separated list of table sizes for the lookup measurements (default: 10,1000,100000). "
+            "Use 0 to skip the table lookups."),
+        QStringLiteral("sizes"),
+        QStringLiteral("10,1000,100000")};
+    QCommandLineOption skipValueBenchmarkOption{
+        QStringLiteral("skip-value-benchmark"),
+        QStringLiteral("Skip the second part with the lookup, path, clone and JSON export measurements.")};
+    QCommandLineOption specificationOption{
+        QStringLiteral("spec"),
+        QStringLiteral("The TOML specification to use, either 1.0 or 1.1 (default: 1.0)."),
+        QStringLiteral("version"),
+        QStringLiteral("1.0")};
+    commandLine.addOption(sizesOption);
+    commandLine.addOption(kindsOption);
+    commandLine.addOption(minimumTimeOption);
+    commandLine.addOption(lookupSizesOption);
+    commandLine.addOption(skipValueBenchmarkOption);
+    commandLine.addOption(specificationOption);
+    commandLine.process(app);
+
+    BenchmarkOptions options;
+    for (const auto &text : commandLine.value(sizesOption).split(QChar{','}, Qt::SkipEmptyParts)) {
+        const auto size = parseSize(text);
+        if (!size.has_value()) {
+            std::cerr << "Invalid size: " << text.toStdString() << " (use B, KB, MB or GB, up to 1GB)" << std::endl;
+            return 1;
+        }
+        options.sizes.push_back(size.value());
+    }
+    if (commandLine.isSet(kindsOption)) {
+        for (const auto &text : commandLine.value(kindsOption).split(QChar{','}, Qt::SkipEmptyParts)) {
+            const auto kind = parseKind(text);
+            if (!kind.has_value()) {
+                std::cerr << "Unknown document kind: " << text.toStdString() << std::endl;
+                return 1;
+            }
+            options.kinds.push_back(kind.value());
+        }
+    } else {
+        options.kinds = DocumentGenerator::allKinds();
+    }
+    for (const auto &text : commandLine.value(lookupSizesOption).split(QChar{','}, Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const auto tableSize = text.trimmed().toInt(&ok);
+        if (!ok || tableSize < 0) {
+            std::cerr << "Invalid lookup table size: " << text.toStdString() << std::endl;
+            return 1;
+        }
+        if (tableSize > 0) {
+            options.lookupTableSizes.push_back(tableSize);
+        }
+    }
+    bool ok = false;
+    options.minimumTime = std::chrono::duration<double>{commandLine.value(minimumTimeOption).toDouble(&ok)};
+    if (!ok || options.minimumTime.count() < 0.0) {
+        std::cerr << "Invalid minimum time." << std::endl;
+        return 1;
+    }
+    const auto specificationText = commandLine.value(specificationOption);
+    if (specificationText == QStringLiteral("1.0")) {
+        options.specification = Specification::Version_1_0;
+    } else if (specificationText == QStringLiteral("1.1")) {
+        options.specification = Specification::Version_1_1;
+    } else {
+        std::cerr << "Unknown specification: " << specificationText.toStdString() << std::endl;
+        return 1;
+    }
+
+    try {
+        Benchmark benchmark{options};
+        benchmark.runOrThrow();
+        if (!commandLine.isSet(skipValueBenchmarkOption)) {
+            ValueBenchmark valueBenchmark{options};
+            valueBenchmark.runOrThrow();
+        }
+    } catch (const Error &error) {
+        std::cerr << "Benchmark failed: " << error.toString().toStdString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
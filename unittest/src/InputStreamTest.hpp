@@ -18,7 +18,10 @@
 
 #include <erbsland/qt/toml/InputStream.hpp>
 
+#include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QString>
+#include <QtCore/QTemporaryDir>
 
 
 using elqt::toml::InputStream;
@@ -78,6 +81,42 @@ public:
         REQUIRE(inputStream->atEnd()); // still at end.
     }
 
+    void verifyLongText(InputStream &inputStream, const QString &text) {
+        const auto expected = text.toUcs4();
+        for (const auto expectedChar : expected) {
+            REQUIRE_FALSE(inputStream.atEnd());
+            auto c = inputStream.readOrThrow();
+            REQUIRE(c == static_cast<unsigned int>(expectedChar));
+        }
+        REQUIRE(inputStream.atEnd());
+    }
+
+    void testLongMixedText() {
+        // The text is about 120 KB long, so the file stream has to read it in many blocks, and the multi-byte
+        // sequences end up at many different offsets relative to the block boundaries.
+        QString text;
+        for (int i = 0; i < 3000; ++i) {
+            text.append(QStringLiteral("key_%1 = \"").arg(i));
+            text.append(QString::fromUtf8("ä⚫😀"));
+            text.append(QString(i % 41, QChar{'x'}));
+            text.append(QStringLiteral("\"\n"));
+        }
+        WITH_CONTEXT(verifyLongText(*InputStream::createFromString(text), text));
+        WITH_CONTEXT(verifyLongText(*InputStream::createFromString(text.toUtf8()), text));
+        QTemporaryDir directory;
+        REQUIRE(directory.isValid());
+        const auto path = QDir{directory.path()}.filePath(QStringLiteral("long_text.txt"));
+        QFile file{path};
+        REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        const auto data = text.toUtf8();
+        REQUIRE(file.write(data) == data.size());
+        file.close();
+        auto inputStream = InputStream::createFromFileOrThrow(path);
+        REQUIRE(inputStream != nullptr);
+        REQUIRE(inputStream->type() == InputStream::Type::File);
+        WITH_CONTEXT(verifyLongText(*inputStream, text));
+    }
+
     void testFile() {
         auto filePath = unitTestExecutablePath().parent_path() / "data" / "input-stream" / "minimal_read.txt";
         auto filePathQt = QString::fromStdString(filePath.string());
@@ -18,17 +18,26 @@
 
 #include <erbsland/qt/toml/Parser.hpp>
 #include <erbsland/qt/toml/Error.hpp>
+#include <erbsland/qt/toml/Location.hpp>
 #include <erbsland/qt/toml/Specification.hpp>
 
 #include <QtCore/QString>
+#include <QtCore/QDir>
+#include <QtCore/QTemporaryDir>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonArray>
+#include <QtCore/QRegularExpression>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <locale>
 #include <vector>
 #include <map>
 #include <sstream>
 #include <filesystem>
+#include <thread>
 
 
 using namespace elqt::toml;
@@ -341,5 +350,463 @@ public:
             }
         }
     }
+
+    void testEncodingErrorLocation() {
+        // Place invalid UTF-8 sequences after ASCII runs of different lengths. The document starts with
+        // 22 bytes, so the first bad byte is located just before, at and after the byte offsets 32, 48, 64 and 96.
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        const auto invalidSequences = std::vector<QByteArray>{
+            QByteArray{"\x80"}, // lone continuation byte
+            QByteArray{"\xc0\xaf"}, // overlong encoding
+            QByteArray{"\xe2\x9a"}, // truncated sequence
+            QByteArray{"\xed\xa0\x80"}, // surrogate
+            QByteArray{"\xf4\x90\x80\x80"}, // beyond U+10FFFF
+        };
+        const auto prefixLengths = std::vector<int>{0, 9, 10, 11, 25, 26, 27, 41, 42, 43, 73, 74, 75};
+        QTemporaryDir directory;
+        REQUIRE(directory.isValid());
+        const auto path = QDir{directory.path()}.filePath(QStringLiteral("encoding.toml"));
+        _testPath = path.toStdString();
+        for (const auto &sequence : invalidSequences) {
+            for (auto prefixLength : prefixLengths) {
+                QByteArray data{"key_1 = 1\nkey_2 = 2\n# "};
+                data.append(QByteArray(prefixLength, 'a'));
+                data.append(sequence);
+                data.append("\nkey_3 = 3\n");
+                QFile file{path};
+                REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+                REQUIRE(file.write(data) == data.size());
+                file.close();
+                // The error must point to the first byte of the invalid sequence, which is the character
+                // after the comment start "# " and the prefix.
+                // The key path shows the tested sequence and prefix length in the failure report.
+                const auto expectedLocation = Location{prefixLength + 22, 3, prefixLength + 3};
+                _keyPath = QStringList{
+                    QStringLiteral("sequence %1").arg(QString::fromLatin1(sequence.toHex())),
+                    QStringLiteral("prefix %1").arg(prefixLength)};
+                _expected = QStringLiteral(" at %1: ").arg(expectedLocation.toString(Location::Format::LongWithIndex));
+                _actual = QStringLiteral("No error");
+                Parser parser{Specification::Version_1_0};
+                try {
+                    parser.parseFileOrThrow(path);
+                } catch (const Error &error) {
+                    _actual = error.toString();
+                }
+                REQUIRE(_actual.startsWith(QStringLiteral("Encoding")));
+                REQUIRE(_actual.contains(_expected));
+            }
+        }
+        _keyPath.clear();
+        _actual.clear();
+        _expected.clear();
+    }
+
+    /// Parse a document from the given data.
+    ///
+    /// The data is written into a temporary file, because this is the path used by most applications.
+    ///
+    auto parseDataOrThrow(const QByteArray &data, Specification specification) -> ValuePtr {
+        QTemporaryDir directory;
+        REQUIRE(directory.isValid());
+        const auto path = QDir{directory.path()}.filePath(QStringLiteral("document.toml"));
+        QFile file{path};
+        REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        REQUIRE(file.write(data) == data.size());
+        file.close();
+        Parser parser{specification};
+        return parser.parseFileOrThrow(path);
+    }
+
+    void testFloatRounding() {
+        // Each float must be converted to the nearest double, like a correctly rounded `strtod` in the C locale does.
+        const auto floatTexts = std::vector<std::string>{
+            "0.1", "0.2", "0.30000000000000004", "1.0", "-0.0", "+0.0", "3.1415", "-0.01", "5e+22", "1e06",
+            "-2E-2", "6.626e-34", "224617.445991228", "1_000.000_1", "9_224_617.445_991_228_313",
+            "1.7976931348623157e308", "2.2250738585072014e-308", "2.2250738585072011e-308",
+            "4.9406564584124654e-324", "2.4703282292062328e-324", "9007199254740993.0",
+            "123456789012345678901234567890.0", "0.000000000000000000000000000000000001234",
+            "7.038531e-26", "1.00000000000000011102230246251565404236316680908203125",
+            "1.00000000000000011102230246251565404236316680908203124",
+            "1.00000000000000011102230246251565404236316680908203126",
+        };
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        QByteArray data;
+        for (std::size_t i = 0; i < floatTexts.size(); ++i) {
+            data.append(QStringLiteral("f_%1 = %2\n").arg(i).arg(QString::fromStdString(floatTexts[i])).toUtf8());
+        }
+        data.append("f_inf = inf\nf_pinf = +inf\nf_ninf = -inf\nf_nan = nan\nf_pnan = +nan\nf_nnan = -nan\n");
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            auto document = parseDataOrThrow(data, specification);
+            for (std::size_t i = 0; i < floatTexts.size(); ++i) {
+                auto text = floatTexts[i];
+                text.erase(std::remove(text.begin(), text.end(), '_'), text.end());
+                // Read the reference value using the classic locale, so it does not depend on the decimal separator.
+                std::istringstream textStream{text};
+                textStream.imbue(std::locale::classic());
+                auto expectedValue = 0.0;
+                textStream >> expectedValue;
+                REQUIRE_FALSE(textStream.fail());
+                const auto value = document->value(QStringLiteral("f_%1").arg(i));
+                _expected = QStringLiteral("%1 => %2").arg(QString::fromStdString(floatTexts[i])).arg(expectedValue, 0, 'g', 17);
+                REQUIRE(value != nullptr);
+                REQUIRE(value->type() == Value::Type::Float);
+                _actual = QStringLiteral("%1 => %2").arg(QString::fromStdString(floatTexts[i])).arg(value->toFloat(), 0, 'g', 17);
+                REQUIRE(value->toFloat() == expectedValue);
+                REQUIRE(std::signbit(value->toFloat()) == std::signbit(expectedValue));
+            }
+            _actual.clear();
+            _expected.clear();
+            REQUIRE(std::isinf(document->floatValue(QStringLiteral("f_inf"))));
+            REQUIRE(document->floatValue(QStringLiteral("f_inf")) > 0.0);
+            REQUIRE(std::isinf(document->floatValue(QStringLiteral("f_pinf"))));
+            REQUIRE(document->floatValue(QStringLiteral("f_pinf")) > 0.0);
+            REQUIRE(std::isinf(document->floatValue(QStringLiteral("f_ninf"))));
+            REQUIRE(document->floatValue(QStringLiteral("f_ninf")) < 0.0);
+            REQUIRE(std::isnan(document->floatValue(QStringLiteral("f_nan"))));
+            REQUIRE(std::isnan(document->floatValue(QStringLiteral("f_pnan"))));
+            REQUIRE(std::isnan(document->floatValue(QStringLiteral("f_nnan"))));
+        }
+    }
+
+    /// Verify that the line and column of a location match its index in the given text.
+    ///
+    void verifyLocationMatchesIndex(const Location &location, const std::vector<char32_t> &text) {
+        _actual = location.toString(Location::Format::LongWithIndex);
+        REQUIRE(location.index() >= 0);
+        REQUIRE(static_cast<std::size_t>(location.index()) <= text.size());
+        int line = 1;
+        int column = 1;
+        for (int i = 0; i < location.index(); ++i) {
+            if (text[i] == '\n') {
+                line += 1;
+                column = 1;
+            } else {
+                column += 1;
+            }
+        }
+        _expected = Location{location.index(), line, column}.toString(Location::Format::LongWithIndex);
+        REQUIRE(location.line() == line);
+        REQUIRE(location.column() == column);
+    }
+
+    void verifyAllLocationsMatchIndex(const ValuePtr &value, const std::vector<char32_t> &text) {
+        WITH_CONTEXT(verifyLocationMatchesIndex(value->locationRange().begin(), text));
+        WITH_CONTEXT(verifyLocationMatchesIndex(value->locationRange().end(), text));
+        if (value->isTable()) {
+            for (const auto &[key, tableValue] : value->toTable()) {
+                _keyPath.append(key);
+                verifyAllLocationsMatchIndex(tableValue, text);
+                _keyPath.removeLast();
+            }
+        } else if (value->isArray()) {
+            for (const auto &arrayValue : value->toArray()) {
+                verifyAllLocationsMatchIndex(arrayValue, text);
+            }
+        }
+    }
+
+    void testLocationsMatchIndex() {
+        // The line and column of every value must be derivable from its index alone. This allows storing only
+        // the index with each value and resolving the line and column on demand.
+        const auto text = QString::fromUtf8(
+            "# Comment with unicode ⚫😀\n"
+            "title = \"⚫ TOML 😀\"\n"
+            "numbers = [1, 2.5, 0x10,\n"
+            "    -3, inf]\n"
+            "multi = \"\"\"\n"
+            "first line\n"
+            "😀 second line\"\"\"\n"
+            "date = 1979-05-27T07:32:00Z\n"
+            "inline = {a = 1, b.c = \"😀\", d = [true, false]}\n"
+            "\n"
+            "[server]\n"
+            "host = 'localhost'\n"
+            "ports = [ 8000,\n"
+            "  8001 ]\n"
+            "\n"
+            "[server.\"⚫\".deep]\n"
+            "value = 1\n"
+            "\n"
+            "[[items]]\n"
+            "name = \"first\"\n"
+            "[[items]]\n"
+            "name = \"😀second\"\n"
+            "sub.key = 2\n");
+        const auto ucs4Text = text.toUcs4();
+        const auto characters = std::vector<char32_t>(ucs4Text.begin(), ucs4Text.end());
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            auto document = parseDataOrThrow(text.toUtf8(), specification);
+            _keyPath.append(QStringLiteral("[root]"));
+            WITH_CONTEXT(verifyAllValuesHaveLocation(document));
+            WITH_CONTEXT(verifyAllLocationsMatchIndex(document, characters));
+            _keyPath.clear();
+        }
+        _actual.clear();
+        _expected.clear();
+    }
+
+    /// Resolve the line and column of an index, using the offsets of the line starts in a text.
+    ///
+    static auto locationFromLineStarts(const std::vector<int> &lineStarts, int index) -> Location {
+        const auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), index);
+        const auto line = static_cast<int>(std::distance(lineStarts.begin(), it));
+        return Location{index, line, index - *(it - 1) + 1};
+    }
+
+    /// Verify that the location of the error for the given document matches the location resolved from its index.
+    ///
+    /// If `requireLocation` is false, errors without a location are accepted.
+    ///
+    void verifyErrorLocation(const QByteArray &data, Specification specification, bool requireLocation) {
+        static const auto locationPattern = QRegularExpression{
+            QStringLiteral(" at (line \\d+, column \\d+ \\(index (\\d+)\\)): ")};
+        _actual = parseErrorText(data, specification);
+        const auto match = locationPattern.match(_actual);
+        if (!requireLocation && !match.hasMatch()) {
+            return;
+        }
+        REQUIRE(match.hasMatch());
+        const auto index = match.captured(2).toInt();
+        // Only the text before the error is required to be valid, which is all that is needed to resolve the index.
+        const auto text = QString::fromUtf8(data).toUcs4();
+        auto lineStarts = std::vector<int>{0};
+        for (int i = 0; i < text.size() && i < index; ++i) {
+            if (text[i] == '\n') {
+                lineStarts.push_back(i + 1);
+            }
+        }
+        _expected = locationFromLineStarts(lineStarts, index).toString(Location::Format::LongWithIndex);
+        REQUIRE(match.captured(1) == _expected);
+    }
+
+    void testErrorLocationsMatchLineStarts() {
+        // The location of syntax and encoding errors must be resolvable from the index alone, using an index
+        // of the line starts. This keeps the error messages exact if locations are stored as index only.
+        const auto documents = std::vector<QByteArray>{
+            "a = 1\nb = \"\xf0\x9f\x98\x80\xe2\x9a\xab\"\nc = = 2\n",
+            "key = \"value\"\n\n# \xe2\x9a\xab comment\n[table]\nx = 1\n[table]\n",
+            "a = [1,\n  2,\n  ]x\n",
+            "a = \"\xf0\x9f\x98\x80\n\"\n",
+            "text = \"\"\"\n\xf0\x9f\x98\x80\n\"\"\"\n[a]\nb = 1\nb = 2\n",
+            "# \xf0\x9f\x98\x80\nkey = 1\n# \xc0\xaf\n",
+        };
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            for (const auto &data : documents) {
+                WITH_CONTEXT(verifyErrorLocation(data, specification, true));
+            }
+            for (const auto &path : getTestFiles("invalid", specification)) {
+                _testPath = path;
+                QFile file{QString::fromStdString(path.string())};
+                REQUIRE(file.open(QIODevice::ReadOnly));
+                const auto data = file.readAll();
+                file.close();
+                WITH_CONTEXT(verifyErrorLocation(data, specification, false));
+            }
+            _testPath.clear();
+        }
+        _actual.clear();
+        _expected.clear();
+    }
+
+    void testParallelParsing() {
+        // Separate parser instances must be safe to use on different threads at the same time.
+        _keyPath.clear();
+        _actual.clear();
+        _expected.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            auto testFiles = getTestFiles("valid", specification);
+            auto invalidFiles = getTestFiles("invalid", specification);
+            testFiles.insert(testFiles.end(), invalidFiles.begin(), invalidFiles.end());
+            auto parseFile = [specification](const fs::path &path) -> QString {
+                try {
+                    Parser parser{specification};
+                    auto value = parser.parseFileOrThrow(QString::fromStdString(path.string()));
+                    return QString::fromUtf8(QJsonDocument{value->toUnitTestJson().toObject()}.toJson(QJsonDocument::Compact));
+                } catch (const Error &error) {
+                    return QStringLiteral("Error: %1").arg(error.toString());
+                }
+            };
+            std::vector<QString> expectedResults;
+            expectedResults.reserve(testFiles.size());
+            for (const auto &path : testFiles) {
+                expectedResults.push_back(parseFile(path));
+            }
+            const auto threadCount = std::max(4U, std::thread::hardware_concurrency());
+            std::vector<QString> actualResults(testFiles.size());
+            std::atomic<std::size_t> nextIndex{0};
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&]() {
+                    for (auto index = nextIndex++; index < testFiles.size(); index = nextIndex++) {
+                        actualResults[index] = parseFile(testFiles[index]);
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            for (std::size_t i = 0; i < testFiles.size(); ++i) {
+                _testPath = testFiles[i];
+                _expected = expectedResults[i];
+                _actual = actualResults[i];
+                REQUIRE(_actual == _expected);
+            }
+            _actual.clear();
+            _expected.clear();
+        }
+    }
+
+    /// Parse the given data and return the error text, or an empty string if the document is valid.
+    ///
+    auto parseErrorText(const QByteArray &data, Specification specification) -> QString {
+        try {
+            parseDataOrThrow(data, specification);
+        } catch (const Error &error) {
+            return error.toString();
+        }
+        return {};
+    }
+
+    void testTableHeadersInMultiLineStrings() {
+        // Lines that look like table headers inside multi-line strings must not start a new table.
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        const auto data = QByteArray{
+            "basic = \"\"\"\n"
+            "[not_a_table]\n"
+            "[[not_an_array]]\n"
+            "value = 1\n"
+            "\"\"\"\n"
+            "literal = '''\n"
+            "[not_a_table]\n"
+            "'''\n"
+            "escaped = \"\"\"\\\"\"\"\n"
+            "[not_a_table]\n"
+            "\"\"\"\n"
+            "[table]\n"
+            "key = 1\n"};
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            auto document = parseDataOrThrow(data, specification);
+            REQUIRE(document->size() == 4);
+            REQUIRE(document->stringValue(QStringLiteral("basic")) == QStringLiteral("[not_a_table]\n[[not_an_array]]\nvalue = 1\n"));
+            REQUIRE(document->stringValue(QStringLiteral("literal")) == QStringLiteral("[not_a_table]\n"));
+            REQUIRE(document->stringValue(QStringLiteral("escaped")) == QStringLiteral("\"\"\"\n[not_a_table]\n"));
+            REQUIRE(document->integerValue(QStringLiteral("table.key")) == 1);
+            REQUIRE_FALSE(document->hasKey(QStringLiteral("not_a_table")));
+            REQUIRE_FALSE(document->hasKey(QStringLiteral("not_an_array")));
+        }
+    }
+
+    void testTableHeadersInMultiLineArrays() {
+        // Lines in multi-line arrays and inline tables that start with brackets must not start a new table.
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        const auto data = QByteArray{
+            "a = [\n"
+            "[1, 2],\n"
+            "[[3]],\n"
+            "]\n"
+            "b = [\n"
+            "  [\"x\"],\n"
+            "  [ [4], [5] ],\n"
+            "  # [not_a_table]\n"
+            "  [[6]]\n"
+            "]\n"
+            "e = {f = [\n"
+            "[7],\n"
+            "[[8]],\n"
+            "]}\n"
+            "[table]\n"
+            "key = 1\n"};
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            auto document = parseDataOrThrow(data, specification);
+            REQUIRE(document->size() == 4);
+            REQUIRE(document->arrayValue(QStringLiteral("a"))->size() == 2);
+            REQUIRE(document->arrayValue(QStringLiteral("a"))->value(0)->size() == 2);
+            REQUIRE(document->arrayValue(QStringLiteral("a"))->value(1)->value(0)->value(0)->toInteger() == 3);
+            REQUIRE(document->arrayValue(QStringLiteral("b"))->size() == 3);
+            REQUIRE(document->arrayValue(QStringLiteral("b"))->value(2)->value(0)->value(0)->toInteger() == 6);
+            REQUIRE(document->arrayValue(QStringLiteral("e.f"))->size() == 2);
+            REQUIRE(document->integerValue(QStringLiteral("table.key")) == 1);
+            for (const auto &key : {"1", "3", "4", "6", "7", "8", "x", "not_a_table"}) {
+                REQUIRE_FALSE(document->hasKey(QString::fromLatin1(key)));
+                REQUIRE_FALSE(document->value(QStringLiteral("table"))->hasKey(QString::fromLatin1(key)));
+            }
+        }
+        // Since TOML 1.1, inline tables can span multiple lines.
+        _testedSpecification = Specification::Version_1_1;
+        auto document = parseDataOrThrow(
+            "g = {\n"
+            "  h = [\n"
+            "[9],\n"
+            "[[10]],\n"
+            "],\n"
+            "}\n"
+            "[table]\n"
+            "key = 1\n", Specification::Version_1_1);
+        REQUIRE(document->size() == 2);
+        REQUIRE(document->arrayValue(QStringLiteral("g.h"))->size() == 2);
+        REQUIRE(document->arrayValue(QStringLiteral("g.h"))->value(1)->value(0)->value(0)->toInteger() == 10);
+        REQUIRE(document->integerValue(QStringLiteral("table.key")) == 1);
+        REQUIRE_FALSE(document->hasKey(QStringLiteral("9")));
+        REQUIRE_FALSE(document->hasKey(QStringLiteral("10")));
+    }
+
+    void testTableDefinitionsAcrossSections() {
+        // Tables that are defined or extended in distant sections of a document.
+        _keyPath.clear();
+        _actualJson = {};
+        _expectedJson = {};
+        for (auto specification : _testedSpecifications) {
+            _testedSpecification = specification;
+            auto document = parseDataOrThrow(
+                "[a.b.c]\nx = 1\n[other]\ny = 1\n[a]\nz = 1\n[a.b]\nw = 1\n"
+                "[[items]]\nv = 1\n[other2]\n[[items]]\nv = 2\n[items.sub]\nu = 3\n", specification);
+            REQUIRE(document->integerValue(QStringLiteral("a.b.c.x")) == 1);
+            REQUIRE(document->integerValue(QStringLiteral("a.z")) == 1);
+            REQUIRE(document->integerValue(QStringLiteral("a.b.w")) == 1);
+            REQUIRE(document->value(QStringLiteral("a"))->source() == Value::Source::ExplicitTable);
+            REQUIRE(document->value(QStringLiteral("a.b"))->source() == Value::Source::ExplicitTable);
+            REQUIRE(document->arrayValue(QStringLiteral("items"))->size() == 2);
+            REQUIRE(document->arrayValue(QStringLiteral("items"))->value(1)->integerValue(QStringLiteral("sub.u")) == 3);
+
+            // Each of these documents redefines a table in line 5.
+            const auto invalidDocuments = std::vector<QByteArray>{
+                "[a]\nx = 1\n[b]\ny = 2\n[a]\nz = 3\n",
+                "[a.b]\nx = 1\n[c]\ny = 2\n[a.b]\nz = 3\n",
+                "[a]\nb.c = 1\n[d]\ne = 1\n[a.b]\nf = 1\n",
+                "[[a]]\nx = 1\n[b]\ny = 2\n[a]\nz = 3\n",
+                "[a]\nx = 1\n[b]\ny = 2\n[[a]]\nz = 3\n",
+            };
+            for (const auto &data : invalidDocuments) {
+                _expected = QStringLiteral("Syntax error at line 5 for: %1").arg(QString::fromUtf8(data));
+                _actual = parseErrorText(data, specification);
+                REQUIRE(_actual.startsWith(QStringLiteral("Syntax")));
+                REQUIRE(_actual.contains(QStringLiteral(" at line 5, ")));
+            }
+            _actual.clear();
+            _expected.clear();
+        }
+    }
 };
 
@@ -35,6 +35,11 @@ public:
     Token token{};
     Token expectedToken{};
 
+    /// Lengths for runs of characters, so the interesting character is located just before, at and
+    /// after the typical 16 and 32 character block boundaries.
+    ///
+    const std::vector<int> _runLengths = {0, 1, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200};
+
     auto additionalErrorMessages() -> std::string override {
         try {
             std::stringstream text;
@@ -566,6 +571,95 @@ public:
         }
     }
 
+    void verifyTokens(const QString &text, const std::vector<Token> &expectedTokens) {
+        auto inputStream = InputStream::createFromString(text);
+        Tokenizer tokenizer{Specification::Version_1_1};
+        tokenizer.startWithStream(inputStream);
+        for (const auto &expected : expectedTokens) {
+            expectedToken = expected;
+            token = tokenizer.read();
+            REQUIRE(token == expectedToken);
+        }
+        expectedToken = Token{TokenType::EndOfDocument, QString{}};
+        token = tokenizer.read();
+        REQUIRE(token.type() == TokenType::EndOfDocument);
+    }
+
+    void readAllTokensOrThrow(const QString &text, Specification specification) {
+        auto inputStream = InputStream::createFromString(text);
+        Tokenizer tokenizer{specification};
+        tokenizer.startWithStream(inputStream);
+        while (tokenizer.read().type() != TokenType::EndOfDocument) {
+        }
+    }
+
+    void testLongWhitespaceAndComments() {
+        for (auto length : _runLengths) {
+            auto whitespace = QString{};
+            for (int i = 0; i < length + 1; ++i) {
+                whitespace.append(i % 3 == 2 ? QLatin1Char('\t') : QLatin1Char(' '));
+            }
+            const auto comment = QStringLiteral("# %1").arg(QString(length, QLatin1Char('c')));
+            const auto text = whitespace + QStringLiteral("key") + whitespace + QStringLiteral("=") + whitespace
+                + QStringLiteral("1") + whitespace + comment + QStringLiteral("\n") + comment;
+            WITH_CONTEXT(verifyTokens(text, {
+                Token{TokenType::Whitespace, QString{}},
+                Token{TokenType::BareKey, QString{"key"}},
+                Token{TokenType::Whitespace, QString{}},
+                Token{TokenType::Assignment, QString{}},
+                Token{TokenType::Whitespace, QString{}},
+                Token{TokenType::DecimalInteger, QString{"1"}},
+                Token{TokenType::Whitespace, QString{}},
+                Token{TokenType::Comment, QString{}},
+                Token{TokenType::NewLine, QString{}},
+                Token{TokenType::Comment, QString{}},
+            }));
+        }
+    }
+
+    void testLongStringBodies() {
+        for (auto length : _runLengths) {
+            const auto a = QString(length, QLatin1Char('a'));
+            const auto b = QString(length, QLatin1Char('b'));
+            const auto c = QString(length, QLatin1Char('c'));
+            const auto text = QStringLiteral("k1=\"%1\\\"%2\\\\%3\"\n").arg(a, b, c)
+                + QStringLiteral("k2=\"\"\"-%1\"-%2\"\"-\\t%3-\"\"\"\n").arg(a, b, c)
+                + QStringLiteral("k3='%1\\%2\"%3'\n").arg(a, b, c)
+                + QStringLiteral("k4='''-%1\n%2''-%3-'''\n").arg(a, b, c);
+            WITH_CONTEXT(verifyTokens(text, {
+                Token{TokenType::BareKey, QString{"k1"}},
+                Token{TokenType::Assignment, QString{}},
+                Token{TokenType::SingleLineString, QStringLiteral("%1\"%2\\%3").arg(a, b, c)},
+                Token{TokenType::NewLine, QString{}},
+                Token{TokenType::BareKey, QString{"k2"}},
+                Token{TokenType::Assignment, QString{}},
+                Token{TokenType::MultiLineString, QStringLiteral("-%1\"-%2\"\"-\t%3-").arg(a, b, c)},
+                Token{TokenType::NewLine, QString{}},
+                Token{TokenType::BareKey, QString{"k3"}},
+                Token{TokenType::Assignment, QString{}},
+                Token{TokenType::SingleLineString, QStringLiteral("%1\\%2\"%3").arg(a, b, c)},
+                Token{TokenType::NewLine, QString{}},
+                Token{TokenType::BareKey, QString{"k4"}},
+                Token{TokenType::Assignment, QString{}},
+                Token{TokenType::MultiLineString, QStringLiteral("-%1\n%2''-%3-").arg(a, b, c)},
+                Token{TokenType::NewLine, QString{}},
+            }));
+        }
+    }
+
+    void testControlCharacterAfterLongRuns() {
+        const auto control = QString{QChar{0x1f}};
+        for (auto specification : {Specification::Version_1_0, Specification::Version_1_1}) {
+            for (auto length : _runLengths) {
+                const auto run = QString(length, QLatin1Char('x'));
+                REQUIRE_THROWS_AS(Error, readAllTokensOrThrow(QStringLiteral("k=\"%1%2\"\n").arg(run, control), specification));
+                REQUIRE_THROWS_AS(Error, readAllTokensOrThrow(QStringLiteral("k=\"\"\"%1%2\"\"\"\n").arg(run, control), specification));
+                REQUIRE_THROWS_AS(Error, readAllTokensOrThrow(QStringLiteral("k='%1%2'\n").arg(run, control), specification));
+                REQUIRE_THROWS_AS(Error, readAllTokensOrThrow(QStringLiteral("# %1%2\n").arg(run, control), specification));
+            }
+        }
+    }
+
     TAGS(output-all-tokens)
     SKIP_BY_DEFAULT()
     void printAllTokens() {